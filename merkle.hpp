@@ -0,0 +1,55 @@
+// Merkle tree rules for batched completion claims, shared by quests.cpp and tools/merkletree.
+// Hashing is left to the caller, so the same code runs in the contract and natively
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace merkle {
+
+    // Leaf is 0x00 || index || account || taskId || reward, integers as 8 byte little endian
+    inline std::array<uint8_t, 33> leaf_data(uint64_t index, uint64_t account, uint64_t taskId, uint64_t reward) {
+        std::array<uint8_t, 33> data{};
+        const uint64_t fields[4] = {index, account, taskId, reward};
+        for (int f = 0; f < 4; f++) {
+            for (int i = 0; i < 8; i++) {
+                data[1 + f * 8 + i] = uint8_t(fields[f] >> (i * 8));
+            }
+        }
+        return data;
+    }
+
+    // Inner node is 0x01 || left || right
+    inline std::array<uint8_t, 65> node_data(const std::array<uint8_t, 32>& left, const std::array<uint8_t, 32>& right) {
+        std::array<uint8_t, 65> data{};
+        data[0] = 1;
+        for (int i = 0; i < 32; i++) {
+            data[1 + i] = left[i];
+            data[33 + i] = right[i];
+        }
+        return data;
+    }
+
+    // Folds proof into node along the path of index, node_hash(left, right) hashes node_data.
+    // The last node of an odd sized level is promoted to the next level as is, so it takes no proof entry.
+    // Returns false if proof does not have exactly one entry per sibling on the path
+    template <typename Digest, typename NodeHash>
+    bool fold(Digest& node, uint64_t index, uint64_t leaves, const std::vector<Digest>& proof, NodeHash node_hash) {
+        size_t used = 0;
+        while (leaves > 1) {
+            if ((index & 1) == 1 || index + 1 < leaves) {
+                if (used >= proof.size()) {
+                    return false;
+                }
+                node = (index & 1) == 1 ? node_hash(proof[used], node) : node_hash(node, proof[used]);
+                used++;
+            }
+            index >>= 1;
+            leaves = (leaves + 1) >> 1;
+        }
+        return used == proof.size();
+    }
+
+}
@@ -1,9 +1,40 @@
 #include <eosio/eosio.hpp>
 #include <eosio/asset.hpp>
 #include <eosio/system.hpp>
+#include <eosio/crypto.hpp>
+#include <string_view>
+
+#include "merkle.hpp"
 
 using namespace eosio;
 
+constexpr uint64_t min_id16 = 1000000000000000ULL;
+constexpr uint64_t max_id16 = 9999999999999999ULL;
+
+// True if id has exactly 16 decimal digits
+constexpr bool is_id16(uint64_t id) {
+    return id >= min_id16 && id <= max_id16;
+}
+
+// Parses a 16 digit id without allocating, returns 0 if value is not one
+constexpr uint64_t parse_id16(std::string_view value) {
+    if (value.size() != 16) {
+        return 0;
+    }
+    uint64_t id = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') {
+            return 0;
+        }
+        id = id * 10 + (c - '0');
+    }
+    return is_id16(id) ? id : 0;
+}
+
+static_assert(is_id16(1000000000000000ULL) && !is_id16(999999999999999ULL) && !is_id16(10000000000000000ULL));
+static_assert(parse_id16("1234567890123456") == 1234567890123456ULL);
+static_assert(parse_id16("0234567890123456") == 0 && parse_id16("12345678901234a6") == 0 && parse_id16("123") == 0);
+
 CONTRACT enigmatest13 : public contract {
 public:
     using contract::contract;
@@ -16,14 +47,14 @@ public:
         std::string questName;
         name account;
         uint64_t communityId;
-        std::string avatar;
+        uint64_t avatar;
 
         // Specify the primary key for the table
         uint64_t primary_key() const { return questId; }
     };
 
     // Define a Multi-Index table with the structure defined above
-    using quests_table = multi_index<"quests"_n, Quest>;
+    using quests_table = multi_index<"quests2"_n, Quest>;
     
     TABLE User {
         uint64_t scoreId;
@@ -37,6 +68,55 @@ public:
 
     using users_table = multi_index<"users"_n, User>;
     TABLE Community {
+        uint64_t communityId;
+        std::string communityName;
+        std::vector<uint64_t> nfts;
+        asset tokens;
+        uint64_t score;
+        uint64_t avatar;
+        name account;
+        uint64_t followers;
+        std::vector<uint64_t> questIds;
+        std::vector<uint64_t> banners;
+
+        uint64_t primary_key() const { return communityId; }
+    };
+
+    using communities_table = multi_index<"communities2"_n, Community>;
+
+    TABLE Tasks {
+        uint64_t taskId;
+        std::string type;
+        std::vector<uint64_t> requirements;
+        std::string taskName;
+        uint64_t reward;
+        uint64_t completedat;
+        std::string description;
+        uint64_t  timescompl;
+        name account;
+        uint64_t relatedquest;
+
+        uint64_t primary_key() const { return taskId; }
+    };
+
+    using tasks_table = multi_index<"tasks2"_n, Tasks>;
+
+    // Layouts from before string interning, kept under the old table names until migrate empties them
+    TABLE LegacyQuest {
+        uint64_t questId;
+        std::vector<uint64_t> tasks;
+        uint64_t end;
+        std::string questName;
+        name account;
+        uint64_t communityId;
+        std::string avatar;
+
+        uint64_t primary_key() const { return questId; }
+    };
+
+    using legacy_quests_table = multi_index<"quests"_n, LegacyQuest>;
+
+    TABLE LegacyCommunity {
         uint64_t communityId;
         std::string communityName;
         std::vector<uint64_t> nfts;
@@ -51,9 +131,9 @@ public:
         uint64_t primary_key() const { return communityId; }
     };
 
-    using communities_table = multi_index<"communities"_n, Community>;
+    using legacy_communities_table = multi_index<"communities"_n, LegacyCommunity>;
 
-    TABLE Tasks {
+    TABLE LegacyTasks {
         uint64_t taskId;
         std::string type;
         std::vector<std::string> requirements;
@@ -68,7 +148,79 @@ public:
         uint64_t primary_key() const { return taskId; }
     };
 
-    using tasks_table = multi_index<"tasks"_n, Tasks>;
+    using legacy_tasks_table = multi_index<"tasks"_n, LegacyTasks>;
+
+    // Interned avatars, banners and requirements, shared by all rows that reference them.
+    // id is the first 8 bytes of sha256(value), 0 is reserved for the empty string
+    TABLE Strings {
+        uint64_t id;
+        std::string value;
+        uint64_t refcount;
+
+        uint64_t primary_key() const { return id; }
+    };
+
+    using strings_table = multi_index<"strings"_n, Strings>;
+
+    // Merkle root of off-chain verified completions, one per quest (scope) and epoch.
+    // leaves is 0 once the epoch is closed
+    TABLE Roots {
+        uint64_t epoch;
+        checksum256 root;
+        uint64_t leaves;
+
+        uint64_t primary_key() const { return epoch; }
+    };
+
+    using roots_table = multi_index<"roots"_n, Roots>;
+
+    // Bitmap of claimed leaves, scoped by quest, 64 leaves per row.
+    // key is epoch << 32 | leaf index / 64
+    TABLE Claimed {
+        uint64_t key;
+        uint64_t bits;
+
+        uint64_t primary_key() const { return key; }
+    };
+
+    using claimed_table = multi_index<"claimed"_n, Claimed>;
+
+    // Read-only views with interned ids resolved back to strings
+    struct QuestView {
+        uint64_t questId;
+        std::vector<uint64_t> tasks;
+        uint64_t end;
+        std::string questName;
+        name account;
+        uint64_t communityId;
+        std::string avatar;
+    };
+
+    struct CommunityView {
+        uint64_t communityId;
+        std::string communityName;
+        std::vector<uint64_t> nfts;
+        asset tokens;
+        uint64_t score;
+        std::string avatar;
+        name account;
+        uint64_t followers;
+        std::vector<uint64_t> questIds;
+        std::vector<std::string> banners;
+    };
+
+    struct TaskView {
+        uint64_t taskId;
+        std::string type;
+        std::vector<std::string> requirements;
+        std::string taskName;
+        uint64_t reward;
+        uint64_t completedat;
+        std::string description;
+        uint64_t  timescompl;
+        name account;
+        uint64_t relatedquest;
+    };
 
     ACTION questaddtask( uint64_t taskId, name account, uint64_t relatedquest) {
         require_auth(account);
@@ -126,15 +278,16 @@ public:
     ACTION createtask(const uint64_t& taskId, const std::string& type, const std::vector<std::string>& requirements, const std::string& taskName, const uint64_t& reward, const std::string& description, const name account)
         {   
             require_auth(account);
-            check(std::to_string(taskId).length() == 16, "task id must be 16 digits long");
+            check(is_id16(taskId), "task id must be 16 digits long");
             quests_table quests(_self, account.value);
             tasks_table tasks(_self, _self.value);
+            legacy_tasks_table legacyTasks(_self, _self.value);
             auto existing_task = tasks.find(taskId);
-            check(existing_task == tasks.end(), "Task with this ID already exists");
+            check(existing_task == tasks.end() && legacyTasks.find(taskId) == legacyTasks.end(), "Task with this ID already exists");
             tasks.emplace(account, [&](auto& row) {
                 row.taskId = taskId;
                 row.type = type;
-                row.requirements = requirements;
+                row.requirements = intern(requirements, account);
                 row.taskName = taskName;
                 row.reward = reward;
                 row.description = description;
@@ -162,56 +315,78 @@ public:
         require_auth(account);
         require_auth(_self);
         check(taskId != 0, "taskId needs to be present");
-        tasks_table tasks(_self, account.value);
-        // in user scope, we store user 
         tasks_table tasksContract(_self, account.value);
-        users_table userScores(_self, account.value);
         auto taskInfo = tasksContract.find(taskId);
         check(taskInfo != tasksContract.end(), "Task is not found");
         auto reward = taskInfo->reward;
         auto relatedquest = taskInfo->relatedquest;
         check(relatedquest != 0, "You cant submit completion of task, that is not tied to any quest.");
-        auto taskreport = tasks.find(taskId);
-        auto relatedquestScore = userScores.find(relatedquest);
-        // if user didnt has task report about this task create one, if he has, update it
-        if (taskreport == tasks.end()) {
-            tasks.emplace(account, [&](auto& row) {
-                row.taskId = taskId;
-                row.completedat = eosio::current_time_point().sec_since_epoch();
-                row.timescompl = 1;
+        record_completion(account, taskId, relatedquest, reward, account, account);
+    }
+
+    // Commits to a batch of (index, account, taskId, reward) completions of questId verified off-chain.
+    // Leaves are claimed afterwards with the claim action
+    ACTION postroot(const uint64_t& questId, const uint64_t& epoch, const checksum256& root, const uint64_t& leaves) {
+        require_auth(_self);
+        check(epoch <= max_epoch, "epoch must fit in 32 bits");
+        check(leaves != 0 && leaves <= max_leaves, "leaves must be between 1 and 2^32");
+        roots_table roots(_self, questId);
+        check(roots.find(epoch) == roots.end(), "Root for this epoch is already posted");
+        roots.emplace(_self, [&](auto& row) {
+            row.epoch = epoch;
+            row.root = root;
+            row.leaves = leaves;
+        });
+    }
+
+    // Applies a completion included in the root posted for questId and epoch.
+    // Can be pushed by anyone, the proof binds the completion to account
+    ACTION claim(const name& account, const uint64_t& questId, const uint64_t& epoch, const uint64_t& index, const uint64_t& taskId, const uint64_t& reward, const std::vector<checksum256>& proof) {
+        roots_table roots(_self, questId);
+        auto root = roots.find(epoch);
+        check(root != roots.end(), "Root for this epoch is not found");
+        check(root->leaves != 0, "Root for this epoch is closed");
+        check(index < root->leaves, "Leaf index is out of range");
+        check(merkle_root(leaf_hash(index, account, taskId, reward), index, root->leaves, proof) == root->root, "Invalid proof");
+
+        claimed_table claimed(_self, questId);
+        uint64_t key = (epoch << 32) | (index >> 6);
+        uint64_t bit = 1ULL << (index & 63);
+        auto word = claimed.find(key);
+        if (word == claimed.end()) {
+            claimed.emplace(_self, [&](auto& row) {
+                row.key = key;
+                row.bits = bit;
             });
-            // if user is not created score for this related quest, add score, if created just append his score
-            if (relatedquestScore == userScores.end()) {
-                userScores.emplace(account, [&](auto& row) {
-                    row.scoreId = relatedquest;
-                    row.account = account;
-                    row.score = reward;
-                    row.subscription = false;
-                });
-            } else {
-                auto existingScore = relatedquestScore->score;
-                userScores.modify(relatedquestScore, account, [&](auto& row) {
-                    row.score = existingScore + reward;
-                });
-            }
         } else {
-            auto timescompletedbefore = taskreport->timescompl;
-            tasks.modify(taskreport, account, [&](auto& row) {
-                row.timescompl = timescompletedbefore + 1;
+            check((word->bits & bit) == 0, "Leaf is already claimed");
+            claimed.modify(word, same_payer, [&](auto& row) {
+                row.bits |= bit;
             });
-            if (relatedquestScore == userScores.end()) {
-                userScores.emplace(account, [&](auto& row) {
-                    row.scoreId = relatedquest;
-                    row.account = account;
-                    row.score = reward;
-                    row.subscription = false;
-                });
-            } else {
-                auto existingScore = relatedquestScore->score;
-                userScores.modify(relatedquestScore, account, [&](auto& row) {
-                    row.score = existingScore + reward;
-                });
-            }
+        }
+        // new rows are billed to the contract, rows the user already pays for stay with the user
+        record_completion(account, taskId, questId, reward, _self, same_payer);
+    }
+
+    // Closes an epoch, revoking its root if it is still open: no more leaves can be claimed, and up to
+    // limit of its claimed bitmap rows are erased. Call again until the bitmap is gone. The root row stays
+    // as a small tombstone, so the epoch cannot be posted again and its leaves credited twice
+    ACTION closeepoch(const uint64_t& questId, const uint64_t& epoch, const uint64_t& limit) {
+        require_auth(_self);
+        check(limit != 0, "limit needs to be present");
+        roots_table roots(_self, questId);
+        auto root = roots.find(epoch);
+        check(root != roots.end(), "Root for this epoch is not found");
+        if (root->leaves != 0) {
+            roots.modify(root, same_payer, [&](auto& row) {
+                row.leaves = 0;
+            });
+        }
+        claimed_table claimed(_self, questId);
+        uint64_t last = (epoch << 32) | 0xFFFFFFFFULL;
+        uint64_t erased = 0;
+        for (auto itr = claimed.lower_bound(epoch << 32); itr != claimed.end() && itr->key <= last && erased < limit; erased++) {
+            itr = claimed.erase(itr);
         }
     }
 
@@ -220,6 +395,7 @@ public:
         tasks_table tasks(_self, _self.value);
         auto iterator = tasks.find(taskId);
         check(iterator != tasks.end(), "Record not found");
+        release(iterator->requirements);
         tasks.erase(iterator);
         action(
             permission_level{_self, "active"_n},
@@ -236,16 +412,18 @@ public:
                     {
                         require_auth(account);
                         require_auth(_self);
-                        check(std::to_string(communityId).length() == 16, "community id must be 16 digits long");
+                        check(is_id16(communityId), "community id must be 16 digits long");
                         communities_table communities(_self, account.value);
+                        legacy_communities_table legacyCommunities(_self, account.value);
+                        check(legacyCommunities.find(communityId) == legacyCommunities.end(), "Community with this ID already exists");
                         communities.emplace(account, [&](auto& row) {
                             row.communityId = communityId;
                             row.communityName = communityName;
                             row.score = 0;
-                            row.avatar = avatar;
+                            row.avatar = intern(avatar, account);
                             row.account = account;
                             row.followers = 0;
-                            row.banners = banners;
+                            row.banners = intern(banners, account);
                         });
                     }
 
@@ -258,10 +436,15 @@ public:
                         auto oldowner = iterator->account;
                         check(oldowner == account, "You cant edit community created by other person.");
                         check(iterator != communities.end(), "Record not found");
+                        // intern the new values before releasing the old ones, so unchanged strings keep their row
+                        auto newavatar = intern(avatar, account);
+                        auto newbanners = intern(banners, account);
+                        release(iterator->avatar);
+                        release(iterator->banners);
                         communities.modify(iterator, account, [&](auto& row) {
                             row.communityName = communityName;
-                            row.avatar = avatar;
-                            row.banners = banners;
+                            row.avatar = newavatar;
+                            row.banners = newbanners;
                         });
                     }
 
@@ -289,9 +472,11 @@ public:
         require_auth(account);
         require_auth(_self);
         check(end >= (eosio::current_time_point().sec_since_epoch() + 24*60*60),"Entered date of quest End is either not a number or its duration is less than 24 hours");
-        check(std::to_string(questId).length() == 16, "questId must be 16 digits long");
+        check(is_id16(questId), "questId must be 16 digits long");
         communities_table communities(get_self(), account.value);
         quests_table quests(get_self(), account.value);
+        legacy_quests_table legacyQuests(get_self(), account.value);
+        check(legacyQuests.find(questId) == legacyQuests.end(), "Quest with this ID already exists");
         if (communityId != 0) {
             auto iterator = communities.find(communityId);
             name commcreator = iterator->account;
@@ -304,7 +489,7 @@ public:
             row.account = account;
             row.communityId = communityId;
             row.questName = questName;
-            row.avatar = avatar;
+            row.avatar = intern(avatar, account);
         });
     }
 
@@ -323,22 +508,25 @@ public:
             check(commcreator == account, "You cant add your quest to not your community");
             check(commiterator != communities.end(), "Community not found");
         }
+        auto newavatar = intern(avatar, account);
+        release(iterator->avatar);
         quests.modify(iterator, account, [&](auto& row) {
             row.communityId = communityId;
             row.end = end;
             row.questName = questName;
-            row.avatar = avatar;
+            row.avatar = newavatar;
         });
     }
 
     [[eosio::on_notify("atomicassets::transfer")]]
     void nft_transfer(name from, name to, std::vector<uint64_t>& asset_ids, std::string memo)
         {
-            check(memo.length() == 16, "In memo you need to specify communityId to which you want to allocate tokens. It must be 16 digits long");
-            for (char c : memo) {
-                check(std::isdigit(c), "Invalid character in a string, only digits allowed");
+            if (to != get_self() || from == get_self()) {
+                return;
             }
-            uint64_t communityId = std::stoull(memo);
+            check(memo.length() == 16, "In memo you need to specify communityId to which you want to allocate tokens. It must be 16 digits long");
+            uint64_t communityId = parse_id16(memo);
+            check(communityId != 0, "memo must be a 16 digit community id");
             communities_table communities(get_self(), from.value);
             auto commun = communities.find(communityId);
             name commauthor = commun->account;
@@ -354,11 +542,12 @@ public:
 
     [[eosio::on_notify("eosio.token::transfer")]]
     void on_transfer(name from, name to, asset quantity, std::string memo){
-            check(memo.length() == 16, "In memo you need to specify communityId to which you want to allocate tokens. It must be 16 digits long");
-            for (char c : memo) {
-                check(std::isdigit(c), "Invalid character in a string, only digits allowed");
+            if (to != get_self() || from == get_self()) {
+                return;
             }
-            uint64_t communityId = std::stoull(memo);
+            check(memo.length() == 16, "In memo you need to specify communityId to which you want to allocate tokens. It must be 16 digits long");
+            uint64_t communityId = parse_id16(memo);
+            check(communityId != 0, "memo must be a 16 digit community id");
             communities_table communities(get_self(), from.value);
             auto commun = communities.find(communityId);
             name commauthor = commun->account;
@@ -368,5 +557,281 @@ public:
                 row.tokens = quantity;
             });
         }
-     	
+
+    // Moves up to limit of account's rows in table from the legacy layout to the interned one.
+    // table is "quests", "communities" or "reports" (task reports in account's scope). The account
+    // signs and pays for the migrated rows and any new strings, as it did for the legacy rows
+    ACTION migrate(const name& table, const name& account, const uint64_t& limit) {
+        require_auth(account);
+        check(account != get_self(), "Contract tasks are migrated with migratetask");
+        check(limit != 0, "limit needs to be present");
+        uint64_t moved = 0;
+        if (table == "quests"_n) {
+            legacy_quests_table legacy(_self, account.value);
+            quests_table quests(_self, account.value);
+            for (auto itr = legacy.begin(); itr != legacy.end() && moved < limit; moved++) {
+                // a row created with the same id before creates checked the legacy table wins
+                if (quests.find(itr->questId) != quests.end()) {
+                    print("Quest ", itr->questId, " already exists, legacy row dropped; ");
+                    itr = legacy.erase(itr);
+                    continue;
+                }
+                quests.emplace(account, [&](auto& row) {
+                    row.questId = itr->questId;
+                    row.tasks = itr->tasks;
+                    row.end = itr->end;
+                    row.questName = itr->questName;
+                    row.account = itr->account;
+                    row.communityId = itr->communityId;
+                    row.avatar = intern(itr->avatar, account);
+                });
+                itr = legacy.erase(itr);
+            }
+        } else if (table == "communities"_n) {
+            legacy_communities_table legacy(_self, account.value);
+            communities_table communities(_self, account.value);
+            for (auto itr = legacy.begin(); itr != legacy.end() && moved < limit; moved++) {
+                if (communities.find(itr->communityId) != communities.end()) {
+                    print("Community ", itr->communityId, " already exists, legacy row dropped; ");
+                    itr = legacy.erase(itr);
+                    continue;
+                }
+                communities.emplace(account, [&](auto& row) {
+                    row.communityId = itr->communityId;
+                    row.communityName = itr->communityName;
+                    row.nfts = itr->nfts;
+                    row.tokens = itr->tokens;
+                    row.score = itr->score;
+                    row.avatar = intern(itr->avatar, account);
+                    row.account = itr->account;
+                    row.followers = itr->followers;
+                    row.questIds = itr->questIds;
+                    row.banners = intern(itr->banners, account);
+                });
+                itr = legacy.erase(itr);
+            }
+        } else if (table == "reports"_n) {
+            legacy_tasks_table legacy(_self, account.value);
+            tasks_table tasks(_self, account.value);
+            for (auto itr = legacy.begin(); itr != legacy.end() && moved < limit; moved++) {
+                if (tasks.find(itr->taskId) != tasks.end()) {
+                    print("Report ", itr->taskId, " already exists, legacy row dropped; ");
+                    itr = legacy.erase(itr);
+                    continue;
+                }
+                tasks.emplace(account, [&](auto& row) {
+                    migrate_task(row, *itr, account);
+                });
+                itr = legacy.erase(itr);
+            }
+        } else {
+            check(false, "Unknown table, expected quests, communities or reports");
+        }
+        check(moved != 0, "Nothing to migrate");
+    }
+
+    // Moves account's tasks in the contract scope from the legacy layout to the interned one,
+    // billed to account like createtask
+    ACTION migratetask(const name& account, const std::vector<uint64_t>& taskIds) {
+        require_auth(account);
+        check(!taskIds.empty(), "taskIds needs to be present");
+        legacy_tasks_table legacy(_self, _self.value);
+        tasks_table tasks(_self, _self.value);
+        for (auto taskId : taskIds) {
+            auto itr = legacy.find(taskId);
+            check(itr != legacy.end(), "Task is not found in the legacy table");
+            check(itr->account == account, "You can migrate only your own tasks");
+            if (tasks.find(taskId) != tasks.end()) {
+                print("Task ", taskId, " already exists, legacy row dropped; ");
+            } else {
+                tasks.emplace(account, [&](auto& row) {
+                    migrate_task(row, *itr, account);
+                });
+            }
+            legacy.erase(itr);
+        }
+    }
+
+    [[eosio::action, eosio::read_only]]
+    QuestView getquest(const uint64_t& questId, const name& account)
+    {
+        quests_table quests(get_self(), account.value);
+        auto quest = quests.find(questId);
+        check(quest != quests.end(), "Record not found");
+        return QuestView{quest->questId, quest->tasks, quest->end, quest->questName, quest->account, quest->communityId, resolve(quest->avatar)};
+    }
+
+    [[eosio::action, eosio::read_only]]
+    CommunityView getcommun(const uint64_t& communityId, const name& account)
+    {
+        communities_table communities(get_self(), account.value);
+        auto commun = communities.find(communityId);
+        check(commun != communities.end(), "Record not found");
+        return CommunityView{commun->communityId, commun->communityName, commun->nfts, commun->tokens, commun->score, resolve(commun->avatar),
+                             commun->account, commun->followers, commun->questIds, resolve(commun->banners)};
+    }
+
+    [[eosio::action, eosio::read_only]]
+    TaskView gettask(const uint64_t& taskId)
+    {
+        tasks_table tasks(get_self(), get_self().value);
+        auto task = tasks.find(taskId);
+        check(task != tasks.end(), "Record not found");
+        return TaskView{task->taskId, task->type, resolve(task->requirements), task->taskName, task->reward, task->completedat,
+                        task->description, task->timescompl, task->account, task->relatedquest};
+    }
+
+private:
+    void migrate_task(Tasks& row, const LegacyTasks& legacy, const name& payer) {
+        row.taskId = legacy.taskId;
+        row.type = legacy.type;
+        row.requirements = intern(legacy.requirements, payer);
+        row.taskName = legacy.taskName;
+        row.reward = legacy.reward;
+        row.completedat = legacy.completedat;
+        row.description = legacy.description;
+        row.timescompl = legacy.timescompl;
+        row.account = legacy.account;
+        row.relatedquest = legacy.relatedquest;
+    }
+
+    static constexpr uint64_t max_epoch = 0xFFFFFFFFULL;
+    static constexpr uint64_t max_leaves = 0x100000000ULL;
+
+    // Adds a completion of taskId to account's task report and its score for questId.
+    // New rows are billed to payer, updated rows to modifypayer
+    void record_completion(const name& account, const uint64_t& taskId, const uint64_t& questId, const uint64_t& reward, const name& payer, const name& modifypayer) {
+        tasks_table tasks(_self, account.value);
+        users_table userScores(_self, account.value);
+        auto taskreport = tasks.find(taskId);
+        auto relatedquestScore = userScores.find(questId);
+        // if user didnt has task report about this task create one, if he has, update it
+        if (taskreport == tasks.end()) {
+            tasks.emplace(payer, [&](auto& row) {
+                row.taskId = taskId;
+                row.completedat = eosio::current_time_point().sec_since_epoch();
+                row.timescompl = 1;
+            });
+        } else {
+            auto timescompletedbefore = taskreport->timescompl;
+            tasks.modify(taskreport, modifypayer, [&](auto& row) {
+                row.timescompl = timescompletedbefore + 1;
+            });
+        }
+        // if user is not created score for this related quest, add score, if created just append his score
+        if (relatedquestScore == userScores.end()) {
+            userScores.emplace(payer, [&](auto& row) {
+                row.scoreId = questId;
+                row.account = account;
+                row.score = reward;
+                row.subscription = false;
+            });
+        } else {
+            auto existingScore = relatedquestScore->score;
+            userScores.modify(relatedquestScore, modifypayer, [&](auto& row) {
+                row.score = existingScore + reward;
+            });
+        }
+    }
+
+    // Hashing rules are in merkle.hpp, shared with tools/merkletree
+    static checksum256 leaf_hash(uint64_t index, const name& account, uint64_t taskId, uint64_t reward) {
+        auto data = merkle::leaf_data(index, account.value, taskId, reward);
+        return sha256(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    static checksum256 node_hash(const checksum256& left, const checksum256& right) {
+        auto data = merkle::node_data(left.extract_as_byte_array(), right.extract_as_byte_array());
+        return sha256(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    static checksum256 merkle_root(checksum256 node, uint64_t index, uint64_t leaves, const std::vector<checksum256>& proof) {
+        check(merkle::fold(node, index, leaves, proof, node_hash), "Proof has a wrong number of entries");
+        return node;
+    }
+
+    static uint64_t string_id(const std::string& value) {
+        auto digest = sha256(value.data(), value.size()).extract_as_byte_array();
+        uint64_t id = 0;
+        for (int i = 0; i < 8; i++) {
+            id = (id << 8) | digest[i];
+        }
+        // 0 means "empty string", never stored
+        return id == 0 ? 1 : id;
+    }
+
+    // Returns the id of value, storing it or bumping its refcount. A new row is billed to payer,
+    // later references share it without paying again
+    uint64_t intern(const std::string& value, const name& payer) {
+        if (value.empty()) {
+            return 0;
+        }
+        strings_table strings(get_self(), get_self().value);
+        uint64_t id = string_id(value);
+        auto itr = strings.find(id);
+        if (itr == strings.end()) {
+            strings.emplace(payer, [&](auto& row) {
+                row.id = id;
+                row.value = value;
+                row.refcount = 1;
+            });
+        } else {
+            check(itr->value == value, "String id collision");
+            strings.modify(itr, same_payer, [&](auto& row) {
+                row.refcount += 1;
+            });
+        }
+        return id;
+    }
+
+    std::vector<uint64_t> intern(const std::vector<std::string>& values, const name& payer) {
+        std::vector<uint64_t> ids;
+        ids.reserve(values.size());
+        for (const auto& value : values) {
+            ids.push_back(intern(value, payer));
+        }
+        return ids;
+    }
+
+    // Drops one reference to id, erasing the row once nothing references it
+    void release(uint64_t id) {
+        if (id == 0) {
+            return;
+        }
+        strings_table strings(get_self(), get_self().value);
+        auto itr = strings.find(id);
+        check(itr != strings.end(), "Interned string not found");
+        if (itr->refcount <= 1) {
+            strings.erase(itr);
+        } else {
+            strings.modify(itr, same_payer, [&](auto& row) {
+                row.refcount -= 1;
+            });
+        }
+    }
+
+    void release(const std::vector<uint64_t>& ids) {
+        for (auto id : ids) {
+            release(id);
+        }
+    }
+
+    std::string resolve(uint64_t id) const {
+        if (id == 0) {
+            return std::string();
+        }
+        strings_table strings(get_self(), get_self().value);
+        auto itr = strings.find(id);
+        check(itr != strings.end(), "Interned string not found");
+        return itr->value;
+    }
+
+    std::vector<std::string> resolve(const std::vector<uint64_t>& ids) const {
+        std::vector<std::string> values;
+        values.reserve(ids.size());
+        for (auto id : ids) {
+            values.push_back(resolve(id));
+        }
+        return values;
+    }
 };
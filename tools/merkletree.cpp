@@ -0,0 +1,72 @@
+// Builds the Merkle root and proofs for the postroot and claim actions of quests.cpp.
+//
+//   cmake -S . -B build && cmake --build build --target merkletree
+//   ./build/merkletree <questId> <epoch> < completions.csv
+//
+// Input is one completion per line: account,taskId,reward
+// Output is the postroot arguments followed by one line of claim arguments per completion, as JSON.
+// The leaf index is the line number, starting from 0.
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "merkletree.hpp"
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage: " << argv[0] << " <questId> <epoch> < completions.csv" << std::endl;
+        return 1;
+    }
+    try {
+        uint64_t questId = parse_u64(argv[1]);
+        uint64_t epoch = parse_u64(argv[2]);
+        if (epoch > 0xFFFFFFFFULL) {
+            throw std::invalid_argument("epoch must fit in 32 bits");
+        }
+
+        std::vector<Completion> completions;
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (line.empty()) {
+                continue;
+            }
+            std::istringstream fields(line);
+            std::string account, taskId, reward;
+            if (!std::getline(fields, account, ',') || !std::getline(fields, taskId, ',') || !std::getline(fields, reward)) {
+                throw std::invalid_argument("expected account,taskId,reward: " + line);
+            }
+            try {
+                completions.push_back({account, parse_u64(taskId), parse_u64(reward)});
+            } catch (const std::invalid_argument& e) {
+                throw std::invalid_argument(std::string(e.what()) + " in line: " + line);
+            }
+        }
+        if (completions.empty() || completions.size() > 0x100000000ULL) {
+            throw std::invalid_argument("leaves must be between 1 and 2^32");
+        }
+
+        auto levels = build_levels(completions);
+
+        std::cout << "{\"questId\":" << questId << ",\"epoch\":" << epoch << ",\"root\":\"" << hex(levels.back()[0])
+                  << "\",\"leaves\":" << completions.size() << "}" << std::endl;
+
+        for (size_t i = 0; i < completions.size(); i++) {
+            std::cout << "{\"account\":\"" << completions[i].account << "\",\"questId\":" << questId << ",\"epoch\":" << epoch
+                      << ",\"index\":" << i << ",\"taskId\":" << completions[i].taskId << ",\"reward\":" << completions[i].reward
+                      << ",\"proof\":[";
+            bool first = true;
+            for (const auto& sibling : proof(levels, i)) {
+                std::cout << (first ? "" : ",") << "\"" << hex(sibling) << "\"";
+                first = false;
+            }
+            std::cout << "]}" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
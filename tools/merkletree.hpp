@@ -0,0 +1,167 @@
+// Merkle tree of quest completions, shared by merkletree.cpp and merkletree_test.cpp.
+// Leaf and node encoding come from merkle.hpp, shared with quests.cpp
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../merkle.hpp"
+
+using digest = std::array<uint8_t, 32>;
+
+struct Completion {
+    std::string account;
+    uint64_t taskId;
+    uint64_t reward;
+};
+
+inline digest sha256(const uint8_t* data, size_t len) {
+    static const uint32_t k[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+    uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    auto rotr = [](uint32_t x, int n) { return (x >> n) | (x << (32 - n)); };
+
+    std::vector<uint8_t> msg(data, data + len);
+    msg.push_back(0x80);
+    while (msg.size() % 64 != 56) {
+        msg.push_back(0);
+    }
+    uint64_t bits = uint64_t(len) * 8;
+    for (int i = 7; i >= 0; i--) {
+        msg.push_back(uint8_t(bits >> (i * 8)));
+    }
+
+    for (size_t chunk = 0; chunk < msg.size(); chunk += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            const uint8_t* p = &msg[chunk + i * 4];
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t t1 = hh + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            hh = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+    }
+
+    digest out;
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 4; j++) {
+            out[i * 4 + j] = uint8_t(h[i] >> (24 - j * 8));
+        }
+    }
+    return out;
+}
+
+// Parses an unsigned decimal number, rejecting anything std::stoull would accept loosely:
+// signs, whitespace, trailing characters and out of range values
+inline uint64_t parse_u64(const std::string& str) {
+    if (str.empty() || str[0] < '0' || str[0] > '9') {
+        throw std::invalid_argument("invalid number: " + str);
+    }
+    size_t pos = 0;
+    uint64_t value = 0;
+    try {
+        value = std::stoull(str, &pos);
+    } catch (const std::exception&) {
+        throw std::invalid_argument("invalid number: " + str);
+    }
+    if (pos != str.size()) {
+        throw std::invalid_argument("invalid number: " + str);
+    }
+    return value;
+}
+
+// Same encoding as eosio::name
+inline uint64_t name_value(const std::string& str) {
+    if (str.empty() || str.size() > 13) {
+        throw std::invalid_argument("invalid account name: " + str);
+    }
+    auto char_value = [&](char c) -> uint64_t {
+        if (c == '.') return 0;
+        if (c >= '1' && c <= '5') return uint64_t(c - '1') + 1;
+        if (c >= 'a' && c <= 'z') return uint64_t(c - 'a') + 6;
+        throw std::invalid_argument("invalid account name: " + str);
+    };
+    uint64_t value = 0;
+    for (size_t i = 0; i < str.size() && i < 12; i++) {
+        value |= (char_value(str[i]) & 0x1f) << (64 - 5 * (i + 1));
+    }
+    if (str.size() == 13) {
+        uint64_t last = char_value(str[12]);
+        if (last > 0x0f) {
+            throw std::invalid_argument("invalid account name: " + str);
+        }
+        value |= last;
+    }
+    return value;
+}
+
+inline digest leaf_hash(uint64_t index, const Completion& c) {
+    auto data = merkle::leaf_data(index, name_value(c.account), c.taskId, c.reward);
+    return sha256(data.data(), data.size());
+}
+
+inline digest node_hash(const digest& left, const digest& right) {
+    auto data = merkle::node_data(left, right);
+    return sha256(data.data(), data.size());
+}
+
+inline std::string hex(const digest& d) {
+    static const char* digits = "0123456789abcdef";
+    std::string out;
+    for (auto b : d) {
+        out += digits[b >> 4];
+        out += digits[b & 0xf];
+    }
+    return out;
+}
+
+// levels[0] are the leaf hashes, the last level holds the root
+inline std::vector<std::vector<digest>> build_levels(const std::vector<Completion>& completions) {
+    std::vector<std::vector<digest>> levels(1);
+    for (size_t i = 0; i < completions.size(); i++) {
+        levels[0].push_back(leaf_hash(i, completions[i]));
+    }
+    while (levels.back().size() > 1) {
+        const auto& prev = levels.back();
+        std::vector<digest> next;
+        for (size_t i = 0; i < prev.size(); i += 2) {
+            // the last node of an odd sized level is promoted as is
+            next.push_back(i + 1 < prev.size() ? node_hash(prev[i], prev[i + 1]) : prev[i]);
+        }
+        levels.push_back(std::move(next));
+    }
+    return levels;
+}
+
+// Siblings on the path of index, bottom up. A promoted node has no sibling and takes no entry
+inline std::vector<digest> proof(const std::vector<std::vector<digest>>& levels, size_t index) {
+    std::vector<digest> siblings;
+    for (size_t level = 0; level + 1 < levels.size(); level++) {
+        size_t sibling = index ^ 1;
+        if (sibling < levels[level].size()) {
+            siblings.push_back(levels[level][sibling]);
+        }
+        index >>= 1;
+    }
+    return siblings;
+}
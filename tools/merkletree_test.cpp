@@ -0,0 +1,75 @@
+// Checks the Merkle tree tooling against known vectors and against merkle::fold, the proof
+// folding used by merkle_root in quests.cpp. Exits non-zero if any check fails.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "merkletree.hpp"
+
+static int failures = 0;
+
+static void expect(bool ok, const std::string& what) {
+    if (!ok) {
+        std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+        failures++;
+    }
+}
+
+// merkle::fold is what merkle_root in quests.cpp runs
+static bool fold(digest node, uint64_t index, uint64_t leaves, const std::vector<digest>& siblings, digest& root) {
+    bool ok = merkle::fold(node, index, leaves, siblings, node_hash);
+    root = node;
+    return ok;
+}
+
+int main() {
+    const uint8_t abc[] = {'a', 'b', 'c'};
+    expect(hex(sha256(abc, 3)) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", "sha256(abc)");
+    expect(hex(sha256(nullptr, 0)) == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", "sha256 of empty input");
+    expect(name_value("eosio") == 0x5530ea0000000000ULL, "name_value(eosio)");
+
+    expect(parse_u64("1234567890123456") == 1234567890123456ULL, "parse_u64 of a valid number");
+    expect(parse_u64("18446744073709551615") == 18446744073709551615ULL, "parse_u64 of the largest number");
+    for (const char* bad : {"", "12x", "-1", "+1", " 1", "1 ", "18446744073709551616"}) {
+        bool rejected = false;
+        try {
+            parse_u64(bad);
+        } catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+        expect(rejected, std::string("parse_u64 rejects \"") + bad + "\"");
+    }
+
+    std::vector<Completion> fixed = {{"alice", 1234567890123456ULL, 10}, {"bob", 1234567890123457ULL, 5}, {"carol", 1234567890123456ULL, 10}};
+    expect(hex(build_levels(fixed).back()[0]) == "5229bb6351879771d0cbf2b7cd4c670a123cb52cdb3f9204763d4aab94fe8f7a", "fixed root of 3 leaves");
+
+    for (size_t n = 1; n <= 70; n++) {
+        std::vector<Completion> completions;
+        for (size_t i = 0; i < n; i++) {
+            completions.push_back({i % 2 == 0 ? "alice" : "bob", 1000000000000000ULL + i, i});
+        }
+        auto levels = build_levels(completions);
+        const digest& root = levels.back()[0];
+        for (size_t i = 0; i < n; i++) {
+            auto siblings = proof(levels, i);
+            std::string leaf = std::to_string(i) + " of " + std::to_string(n);
+            digest folded;
+            expect(fold(levels[0][i], i, n, siblings, folded) && folded == root, "proof of leaf " + leaf);
+
+            Completion forged = completions[i];
+            forged.reward += 1;
+            expect(!fold(leaf_hash(i, forged), i, n, siblings, folded) || folded != root, "forged reward of leaf " + leaf);
+            if (n > 1) {
+                expect(!fold(levels[0][i], i ^ 1, n, siblings, folded) || folded != root, "wrong index of leaf " + leaf);
+            }
+        }
+    }
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("merkletree_test passed\n");
+    return 0;
+}
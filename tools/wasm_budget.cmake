@@ -0,0 +1,16 @@
+# cmake -DWASM=<quests.wasm> -DBUDGET=<wasm_budget.txt> -P wasm_budget.cmake
+
+if(NOT EXISTS "${WASM}")
+    message(FATAL_ERROR "${WASM} not found, build the quests_wasm target first")
+endif()
+
+file(SIZE "${WASM}" size)
+file(STRINGS "${BUDGET}" budget REGEX "^[0-9]+$" LIMIT_COUNT 1)
+if(NOT budget)
+    message(FATAL_ERROR "quests.wasm is ${size} bytes, but no budget is recorded. Add the measured size to ${BUDGET}")
+endif()
+
+message(STATUS "quests.wasm: ${size} bytes, budget ${budget} bytes")
+if(size GREATER budget)
+    message(FATAL_ERROR "quests.wasm is ${size} bytes, over the budget of ${budget} bytes")
+endif()